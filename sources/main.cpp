@@ -1,7 +1,10 @@
 #include "people_counter.h"
+#include <memory>
+#ifdef _WIN32
 #include <windows.h>
 #include <Shlwapi.h>
 #pragma comment(lib, "shlwapi.lib")
+#endif
 
 
 const char* keys =
@@ -17,16 +20,65 @@ const char* keys =
 "{wts     |net.wts| network weights                    }"
 "{nms     |net.nms| network object classes             }"
 "{zsf     |0.01| zooming speed factor                   }"
+"{rec     || record annotated video, output file prefix }"
+"{rfps    |0| recorded video frame rate, 0 - capture rate / rdec }"
+"{rseg    |0| frames per recorded file, 0 - one file   }"
+"{rdec    |1| record every n-th annotated frame        }"
+"{rq      |32| recorder queue size, frames over it are dropped }"
+"{replay  || replay video file headless and report throughput }"
+"{stride  |1| replay every n-th frame                  }"
+"{report  || write replay report to this file          }"
+"{baseline|| compare replay against this report file   }"
+"{tol     |0.1| allowed slowdown of fps and stage times, fraction of baseline }"
+"{ctol    |0| allowed people count difference per frame }"
 ;
 
+// Recorder for the annotated frames if --rec is given, nullptr on bad options
+VideoRecorder* createRecorder(const cv::CommandLineParser& parser, const std::string& path_prefix, cv::VideoCapture& cap)
+{
+	int segmentFrames = parser.get<int>("rseg");
+	int decimation = parser.get<int>("rdec");
+	int queueSize = parser.get<int>("rq");
+	if (segmentFrames < 0 || decimation <= 0 || queueSize <= 0) {
+		std::cerr << "Recorder needs rseg >= 0, rdec > 0 and rq > 0\n";
+		return nullptr;
+	}
+
+	// By default the clips play back in real time
+	double fps = parser.get<double>("rfps");
+	if (fps <= 0.0) {
+		fps = cap.get(cv::CAP_PROP_FPS);
+		if (fps <= 0.0) {
+			fps = 25.0;
+		}
+		fps /= decimation;
+	}
+
+	return new VideoRecorder(path_prefix + parser.get<std::string>("rec"),
+		fps, segmentFrames, decimation, (size_t)queueSize);
+}
+
+void printRecorderStats(VideoRecorder& recorder)
+{
+	std::cout << "Recorded [ " << recorder.getEncodedQty() << " ] frames, dropped [ "
+		<< recorder.getDroppedQty() << " ] frames\n";
+	if (recorder.isFailed()) {
+		std::cout << "Recording stopped, the output file couldn't be opened\n";
+	}
+}
+
 int main(int argc, char** argv)
 {
+#ifdef _WIN32
 	char szEXEPath[2048];
 	GetModuleFileName(NULL, szEXEPath, 2048);
 	PathRemoveFileSpec(szEXEPath);
 	
 	std::string strExePath = szEXEPath;
 	strExePath += "\\";	
+#else
+	std::string strExePath;
+#endif
 
     cv::CommandLineParser parser(argc, argv, keys);
     parser.about("Use this application to count the number of people in a video stream.");
@@ -35,6 +87,62 @@ int main(int argc, char** argv)
         return 0;
     }
     
+    // Deterministic replay for throughput regression testing, no windows are created
+    if (parser.has("replay")) {
+        ReplayReport report;
+        report.source = parser.get<std::string>("replay");
+        report.modelConfiguration = parser.get<std::string>("cfg");
+        report.modelWeights = parser.get<std::string>("wts");
+        
+        cv::VideoCapture replayCap(strExePath + report.source);
+        if (!replayCap.isOpened()) {
+            std::cerr << "Can't open " << report.source << "\n";
+            return 1;
+        }
+        
+        PeopleCounter peopleCounter(replayCap,
+            strExePath + parser.get<std::string>("cfg"), strExePath + parser.get<std::string>("wts"), strExePath + parser.get<std::string>("nms"),
+            parser.get<float>("ct"), parser.get<float>("st"),
+            parser.get<int>("iw"), parser.get<int>("ih"), parser.get<float>("zsf"));
+        
+        std::unique_ptr<VideoRecorder> recorder;
+        if (parser.has("rec")) {
+            recorder.reset(createRecorder(parser, strExePath, replayCap));
+            if (!recorder) {
+                return 1;
+            }
+            recorder->start();
+            peopleCounter.setRecorder(recorder.get());
+        }
+        
+        peopleCounter.runReplay(report, parser.get<int>("stride"));
+        printReplayReport(report);
+        
+        if (recorder) {
+            recorder->stop();
+            printRecorderStats(*recorder);
+        }
+        
+        // Nothing was decoded, don't let it become a baseline
+        if (report.frames.empty()) {
+            std::cerr << "No frames were replayed from " << report.source << "\n";
+            return 1;
+        }
+        
+        if (parser.has("report") && !writeReplayReport(strExePath + parser.get<std::string>("report"), report)) {
+            return 1;
+        }
+        
+        if (parser.has("baseline")) {
+            ReplayReport baseline;
+            if (!readReplayReport(strExePath + parser.get<std::string>("baseline"), baseline)) {
+                return 1;
+            }
+            return compareReplayReports(report, baseline, parser.get<double>("tol"), parser.get<int>("ctol")) ? 0 : 1;
+        }
+        return 0;
+    }
+    
     cv::VideoCapture cap;
 	cv::Mat image;
     
@@ -66,7 +174,23 @@ int main(int argc, char** argv)
 			strExePath + parser.get<std::string>("cfg"), strExePath + parser.get<std::string>("wts"), strExePath + parser.get<std::string>("nms"),
             parser.get<float>("ct"), parser.get<float>("st"),
             parser.get<int>("iw"), parser.get<int>("ih"), parser.get<float>("zsf"));        
-			peopleCounter.runThreads();
+
+		std::unique_ptr<VideoRecorder> recorder;
+		if (parser.has("rec")) {
+			recorder.reset(createRecorder(parser, strExePath, cap));
+			if (!recorder) {
+				return 1;
+			}
+			recorder->start();
+			peopleCounter.setRecorder(recorder.get());
+		}
+
+		peopleCounter.runThreads();
+
+		if (recorder) {
+			recorder->stop();
+			printRecorderStats(*recorder);
+		}
     }
 	if (!image.empty())                      // Check for invalid input
 	{
@@ -15,6 +15,10 @@ _confThreshold(ct),
 _nmsThreshold(st),
 _inpWidth(iw),
 _inpHeight(ih),
+_inferenceTime(0.0),
+_postprocessTime(0.0),
+_recorder(nullptr),
+_captureSeq(0),
 _threadsEnabled(true)
 {
     _captureFrameWidth = static_cast<int>(_capture.get(cv::CAP_PROP_FRAME_WIDTH));
@@ -51,6 +55,10 @@ PeopleCounter::PeopleCounter(cv::Mat& img,
 	_nmsThreshold(st),
 	_inpWidth(iw),
 	_inpHeight(ih),
+	_inferenceTime(0.0),
+	_postprocessTime(0.0),
+	_recorder(nullptr),
+	_captureSeq(0),
 	_threadsEnabled(true)
 {
 	_captureFrameWidth = static_cast<int>(_image.size().width);
@@ -82,6 +90,7 @@ void PeopleCounter::producer() {
         {
             std::lock_guard<std::mutex> lck(_mutexFrameCapture);
             _lastCapturedFrame = frame.clone();
+            _captureSeq++;
         }
         
         // Stop the program if no video stream
@@ -125,40 +134,23 @@ void PeopleCounter::runThreads() {
     cv::namedWindow(kWinName, cv::WINDOW_NORMAL);
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
     
+    // The loop runs much faster than the capture, record each captured frame once
+    size_t recordedSeq = 0;
+    
     while (_threadsEnabled) {
         if (cv::waitKey(1) >= 0) {
             _threadsEnabled = false;
             break;
         }
         
-        {
-            std::lock(_mutexFrameRegion, _mutexFrameOverlay, _mutexFrameCapture);
-            std::lock_guard<std::mutex> lckRegion(_mutexFrameRegion, std::adopt_lock);
-            std::lock_guard<std::mutex> lckOverlay(_mutexFrameOverlay, std::adopt_lock);
-            std::lock_guard<std::mutex> lckCapture(_mutexFrameCapture, std::adopt_lock);
-            
-            updateFrameRegionToShow();
-            
-            if (!_lastCapturedFrame.empty() && !_lastOverlayFrame.empty()) {
-                // Blur the background
-                cv::Mat blurred = cv::Mat::zeros(_lastCapturedFrame.size(), _lastCapturedFrame.type());
-                cv::GaussianBlur(_lastCapturedFrame, blurred, cv::Size(15, 15), 0.0);   
-                blurred.copyTo(_lastCapturedFrame, _blurMask);                
-                cv::bitwise_or(_lastCapturedFrame, _lastOverlayFrame, _lastOverlayedFrame);
-            }
-            
-            if (!_lastOverlayedFrame.empty()) {
-				cv::Mat frame = _lastOverlayedFrame(_frameRegionToShowZoomed);
-                padAspectRatio(frame, (float)_inpWidth / (float)_inpHeight);                
-                cv::resize(frame, frame, cv::Size(_inpWidth, _inpHeight));
-                
-                if (!frame.empty()) {
-					cv::Mat _image = _lastOverlayedFrame;
-
-				
-                    cv::imshow(kWinName, frame);
-                }
-            }
+        cv::Mat frame, overlayed;
+        if (composeLatestFrame(frame, overlayed, recordedSeq)) {
+            cv::imshow(kWinName, frame);
+        }
+        
+        // push() copies the frame, do it without blocking the producer
+        if (!overlayed.empty()) {
+            _recorder->push(overlayed);
         }
     }
     
@@ -177,40 +169,122 @@ void PeopleCounter::runDetectIamge()
 	std::this_thread::sleep_for(std::chrono::milliseconds(10));
 	processFrame(_image);
 
-	std::lock(_mutexFrameRegion, _mutexFrameOverlay, _mutexFrameCapture);
-	std::lock_guard<std::mutex> lckRegion(_mutexFrameRegion, std::adopt_lock);
-	std::lock_guard<std::mutex> lckOverlay(_mutexFrameOverlay, std::adopt_lock);
-	std::lock_guard<std::mutex> lckCapture(_mutexFrameCapture, std::adopt_lock);
-
-	updateFrameRegionToShow();
-
-
-	if (!_lastCapturedFrame.empty() && !_lastOverlayFrame.empty()) {
-		// Blur the background
-		cv::Mat blurred = cv::Mat::zeros(_lastCapturedFrame.size(), _lastCapturedFrame.type());
-		cv::GaussianBlur(_lastCapturedFrame, blurred, cv::Size(15, 15), 0.0);		
-		blurred.copyTo(_lastCapturedFrame, _blurMask);
-		cv::bitwise_or(_lastCapturedFrame, _lastOverlayFrame, _lastOverlayedFrame);
-	}
-
-	if (!_lastOverlayedFrame.empty()) {
-		cv::Mat frame = _lastOverlayedFrame(_frameRegionToShowZoomed);
-		padAspectRatio(frame, (float)_inpWidth / (float)_inpHeight);
-		cv::resize(frame, frame, cv::Size(_inpWidth, _inpHeight));
-		if (!frame.empty()) {
-			cv::imshow(kWinName, frame);
-		}
+	cv::Mat frame, overlayed;
+	size_t recordedSeq = _captureSeq;
+	if (composeLatestFrame(frame, overlayed, recordedSeq)) {
+		cv::imshow(kWinName, frame);
 	}
 	std::cout << "There are [ " << _peopleQty << " ] peoples\n";
 	
 	cv::waitKey(0);
 }
 
+void PeopleCounter::runReplay(ReplayReport& report, int stride) {
+    std::cout << "\nStarting Replay\n";
+    stride = std::max(stride, 1);
+    
+    // Simulated clock of the recorded video, independent of how fast we process it
+    double sourceFps = _capture.get(cv::CAP_PROP_FPS);
+    if (sourceFps <= 0.0) {
+        sourceFps = 25.0;
+    }
+    
+    report.stride = stride;
+    report.sourceFps = sourceFps;
+    report.inpWidth = _inpWidth;
+    report.inpHeight = _inpHeight;
+    report.confThreshold = _confThreshold;
+    report.nmsThreshold = _nmsThreshold;
+    report.recording = _recorder != nullptr;
+    
+    // Untimed forward pass, the first one sets up and allocates the network
+    cv::Mat blob;
+    std::vector<cv::Mat> outs;
+    cv::dnn::blobFromImage(cv::Mat::zeros(_inpHeight, _inpWidth, CV_8UC3), blob, 1 / 255.0, cv::Size(_inpWidth, _inpHeight), cv::Scalar(0, 0, 0), true, false);
+    _net.setInput(blob);
+    _net.forward(outs, getOutputsNames(_net));
+    
+    size_t recordedSeq = _captureSeq;
+    double freq = cv::getTickFrequency() / 1000;
+    double captureTime = 0.0, inferenceTime = 0.0, postprocessTime = 0.0, composeTime = 0.0;
+    int64 start = cv::getTickCount();
+    cv::Mat frame;
+    
+    for (int index = 0; ; ++index) {
+        // Every read is timed, decoding the frames skipped by the stride is part of the capture stage
+        int64 t0 = cv::getTickCount();
+        _capture.read(frame);
+        if (frame.empty()) {
+            break;
+        }
+        report.readFrames++;
+        
+        if (index % stride != 0) {
+            captureTime += (cv::getTickCount() - t0) / freq;
+            continue;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lck(_mutexFrameCapture);
+            _lastCapturedFrame = frame.clone();
+            _captureSeq++;
+        }
+        int64 t1 = cv::getTickCount();
+        
+        processFrame(frame);
+        int64 t2 = cv::getTickCount();
+        
+        cv::Mat composed, overlayed;
+        composeLatestFrame(composed, overlayed, recordedSeq);
+        
+        // Recorder overhead is part of the compose stage
+        if (!overlayed.empty()) {
+            _recorder->push(overlayed);
+        }
+        int64 t3 = cv::getTickCount();
+        
+        captureTime += (t1 - t0) / freq;
+        inferenceTime += _inferenceTime;
+        postprocessTime += _postprocessTime;
+        composeTime += (t3 - t2) / freq;
+        
+        ReplayFrame replayFrame;
+        replayFrame.index = index;
+        replayFrame.timestamp = index / sourceFps;
+        replayFrame.peopleQty = _peopleQty;
+        report.frames.push_back(replayFrame);
+    }
+    
+    report.wallSeconds = (cv::getTickCount() - start) / cv::getTickFrequency();
+    report.simulatedSeconds = report.readFrames / sourceFps;
+    
+    size_t processed = report.frames.size();
+    if (processed > 0) {
+        report.fps = report.wallSeconds > 0.0 ? processed / report.wallSeconds : 0.0;
+        report.captureTime = captureTime / processed;
+        report.inferenceTime = inferenceTime / processed;
+        report.postprocessTime = postprocessTime / processed;
+        report.composeTime = composeTime / processed;
+    }
+    
+    if (_capture.isOpened()) {
+        _capture.release();
+    }
+    std::cout << "\nStopping Replay\n";
+}
+
 int PeopleCounter::getPeopleQty() {
     return _peopleQty;
 }
 
+void PeopleCounter::setRecorder(VideoRecorder* recorder) {
+    _recorder = recorder;
+}
+
 void PeopleCounter::processFrame(cv::Mat& frame) {
+    double freq = cv::getTickFrequency() / 1000;
+    int64 t0 = cv::getTickCount();
+    
     // Create a 4D blob from a frame.
     cv::Mat blob;
     cv::dnn::blobFromImage(frame, blob, 1 / 255.0, cv::Size(_inpWidth, _inpHeight), cv::Scalar(0, 0, 0), true, false);
@@ -219,9 +293,58 @@ void PeopleCounter::processFrame(cv::Mat& frame) {
     std::vector<cv::Mat> outs;
     _net.setInput(blob);
     _net.forward(outs, getOutputsNames(_net));
+    int64 t1 = cv::getTickCount();
     
     // Filter out low confidence objects
     _peopleQty = countPeople(frame, outs);
+    int64 t2 = cv::getTickCount();
+    
+    _inferenceTime = (t1 - t0) / freq;
+    _postprocessTime = (t2 - t1) / freq;
+}
+
+// Blur the background, put the overlay on top and cut out the zoomed region.
+// Expects the region, overlay and capture mutexes to be held by the caller.
+bool PeopleCounter::composeFrame(cv::Mat& frame) {
+    if (!_lastCapturedFrame.empty() && !_lastOverlayFrame.empty()) {
+        // Blur the background
+        cv::Mat blurred = cv::Mat::zeros(_lastCapturedFrame.size(), _lastCapturedFrame.type());
+        cv::GaussianBlur(_lastCapturedFrame, blurred, cv::Size(15, 15), 0.0);
+        blurred.copyTo(_lastCapturedFrame, _blurMask);
+        cv::bitwise_or(_lastCapturedFrame, _lastOverlayFrame, _lastOverlayedFrame);
+    }
+    
+    if (_lastOverlayedFrame.empty()) {
+        return false;
+    }
+    
+    frame = _lastOverlayedFrame(_frameRegionToShowZoomed);
+    padAspectRatio(frame, (float)_inpWidth / (float)_inpHeight);
+    cv::resize(frame, frame, cv::Size(_inpWidth, _inpHeight));
+    return !frame.empty();
+}
+
+// Move the zoom and compose the latest captured frame under the frame locks.
+// If a recorder is set and a new frame was captured since recordedSeq, overlayed
+// gets the full resolution composite. Only the calling thread writes it, so it
+// stays valid outside the locks until the next call.
+bool PeopleCounter::composeLatestFrame(cv::Mat& frame, cv::Mat& overlayed, size_t& recordedSeq) {
+    std::lock(_mutexFrameRegion, _mutexFrameOverlay, _mutexFrameCapture);
+    std::lock_guard<std::mutex> lckRegion(_mutexFrameRegion, std::adopt_lock);
+    std::lock_guard<std::mutex> lckOverlay(_mutexFrameOverlay, std::adopt_lock);
+    std::lock_guard<std::mutex> lckCapture(_mutexFrameCapture, std::adopt_lock);
+    
+    updateFrameRegionToShow();
+    
+    if (!composeFrame(frame)) {
+        return false;
+    }
+    
+    if (_recorder && _captureSeq != recordedSeq) {
+        overlayed = _lastOverlayedFrame;
+        recordedSeq = _captureSeq;
+    }
+    return true;
 }
 
 int PeopleCounter::countPeople(cv::Mat& frame, const std::vector<cv::Mat>& outs)
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <sstream>
 #include <thread>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -12,6 +13,8 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgcodecs.hpp>
+#include "video_recorder.h"
+#include "replay_report.h"
 
 
 
@@ -29,7 +32,11 @@ public:
     
     void runThreads();
 	void runDetectIamge();
+    // Headless, processes the video frame by frame on the simulated clock of the source
+    void runReplay(ReplayReport& report, int stride = 1);
     int getPeopleQty();
+    // Optional archive of the annotated frames, not owned
+    void setRecorder(VideoRecorder* recorder);
     
 private:
 	enum DetectSource {
@@ -42,6 +49,8 @@ private:
     void drawPred(int classId, float conf, int left, int top, int right, int bottom, cv::Mat& frame);
     int countPeople(cv::Mat& frame, const std::vector<cv::Mat>& outs);
     void processFrame(cv::Mat& frame);	
+    bool composeFrame(cv::Mat& frame);
+    bool composeLatestFrame(cv::Mat& frame, cv::Mat& overlayed, size_t& recordedSeq);
     void updateFrameRegionToShow();
     void boundRegionToCaptureFrame(cv::Rect& region);
     void adjustFrameRegion(cv::Rect& region, cv::Rect& box);
@@ -86,6 +95,12 @@ private:
     int _inpHeight;                    // Height of network's input image
     std::vector<std::string> _classes;
     
+    double _inferenceTime;            // Blob and forward pass time of the last frame, ms
+    double _postprocessTime;        // Filtering and overlay time of the last frame, ms
+    
+    VideoRecorder* _recorder;
+    size_t _captureSeq;               // incremented for every captured frame
+    
     bool _threadsEnabled;
     std::mutex _mutexFrameCapture;
     std::mutex _mutexFrameRegion;
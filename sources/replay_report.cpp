@@ -0,0 +1,181 @@
+#include "replay_report.h"
+
+ReplayReport::ReplayReport() :
+inpWidth(0),
+inpHeight(0),
+confThreshold(0.0f),
+nmsThreshold(0.0f),
+recording(false),
+stride(1),
+readFrames(0),
+sourceFps(0.0),
+simulatedSeconds(0.0),
+wallSeconds(0.0),
+fps(0.0),
+captureTime(0.0),
+inferenceTime(0.0),
+postprocessTime(0.0),
+composeTime(0.0)
+{
+}
+
+bool writeReplayReport(const std::string& path, const ReplayReport& report) {
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        std::cerr << "Can't write replay report " << path << "\n";
+        return false;
+    }
+
+    fs << "source" << report.source;
+    fs << "cfg" << report.modelConfiguration;
+    fs << "wts" << report.modelWeights;
+    fs << "iw" << report.inpWidth;
+    fs << "ih" << report.inpHeight;
+    fs << "ct" << report.confThreshold;
+    fs << "st" << report.nmsThreshold;
+    fs << "recording" << (int)report.recording;
+    fs << "stride" << report.stride;
+    fs << "read_frames" << report.readFrames;
+    fs << "source_fps" << report.sourceFps;
+    fs << "simulated_seconds" << report.simulatedSeconds;
+    fs << "wall_seconds" << report.wallSeconds;
+    fs << "fps" << report.fps;
+
+    fs << "stages" << "{";
+    fs << "capture_ms" << report.captureTime;
+    fs << "inference_ms" << report.inferenceTime;
+    fs << "postprocess_ms" << report.postprocessTime;
+    fs << "compose_ms" << report.composeTime;
+    fs << "}";
+
+    fs << "frames" << "[";
+    for (size_t i = 0; i < report.frames.size(); ++i) {
+        const ReplayFrame& frame = report.frames[i];
+        fs << "{:" << "index" << frame.index << "timestamp" << frame.timestamp << "people" << frame.peopleQty << "}";
+    }
+    fs << "]";
+
+    return true;
+}
+
+bool readReplayReport(const std::string& path, ReplayReport& report) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        std::cerr << "Can't read replay report " << path << "\n";
+        return false;
+    }
+
+    // Missing keys would read as zeros and let any run pass
+    const char* keys[] = { "source", "cfg", "wts", "iw", "ih", "ct", "st", "recording", "stride", "fps", "stages", "frames" };
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+        if (fs[keys[i]].empty()) {
+            std::cerr << "Replay report " << path << " has no " << keys[i] << "\n";
+            return false;
+        }
+    }
+
+    int recording = 0;
+    fs["source"] >> report.source;
+    fs["cfg"] >> report.modelConfiguration;
+    fs["wts"] >> report.modelWeights;
+    fs["iw"] >> report.inpWidth;
+    fs["ih"] >> report.inpHeight;
+    fs["ct"] >> report.confThreshold;
+    fs["st"] >> report.nmsThreshold;
+    fs["recording"] >> recording;
+    report.recording = recording != 0;
+    fs["stride"] >> report.stride;
+    fs["read_frames"] >> report.readFrames;
+    fs["source_fps"] >> report.sourceFps;
+    fs["simulated_seconds"] >> report.simulatedSeconds;
+    fs["wall_seconds"] >> report.wallSeconds;
+    fs["fps"] >> report.fps;
+
+    cv::FileNode stages = fs["stages"];
+    stages["capture_ms"] >> report.captureTime;
+    stages["inference_ms"] >> report.inferenceTime;
+    stages["postprocess_ms"] >> report.postprocessTime;
+    stages["compose_ms"] >> report.composeTime;
+
+    report.frames.clear();
+    cv::FileNode frames = fs["frames"];
+    for (cv::FileNodeIterator it = frames.begin(); it != frames.end(); ++it) {
+        ReplayFrame frame;
+        (*it)["index"] >> frame.index;
+        (*it)["timestamp"] >> frame.timestamp;
+        (*it)["people"] >> frame.peopleQty;
+        report.frames.push_back(frame);
+    }
+
+    return true;
+}
+
+void printReplayReport(const ReplayReport& report) {
+    std::cout << cv::format("Replayed [ %d ] frames, processed [ %d ] in %.2f s (%.2f s simulated)\n",
+                            report.readFrames, (int)report.frames.size(), report.wallSeconds, report.simulatedSeconds);
+    std::cout << cv::format("End-to-end : %.2f fps\n", report.fps);
+    std::cout << cv::format("Capture    : %.2f ms\n", report.captureTime);
+    std::cout << cv::format("Inference  : %.2f ms\n", report.inferenceTime);
+    std::cout << cv::format("Postprocess: %.2f ms\n", report.postprocessTime);
+    std::cout << cv::format("Compose    : %.2f ms\n", report.composeTime);
+}
+
+bool compareReplayReports(const ReplayReport& report, const ReplayReport& baseline,
+                          double tolerance, int count_tolerance) {
+    bool passed = true;
+
+    // Numbers from a different configuration can't be compared
+    if (report.source != baseline.source ||
+        report.modelConfiguration != baseline.modelConfiguration ||
+        report.modelWeights != baseline.modelWeights ||
+        report.inpWidth != baseline.inpWidth || report.inpHeight != baseline.inpHeight ||
+        std::abs(report.confThreshold - baseline.confThreshold) > 1e-6 ||
+        std::abs(report.nmsThreshold - baseline.nmsThreshold) > 1e-6 ||
+        report.recording != baseline.recording || report.stride != baseline.stride) {
+        std::cout << cv::format("FAIL run %s %s %s %dx%d ct %.2f st %.2f rec %d stride %d, baseline %s %s %s %dx%d ct %.2f st %.2f rec %d stride %d\n",
+                                report.source.c_str(), report.modelConfiguration.c_str(), report.modelWeights.c_str(),
+                                report.inpWidth, report.inpHeight, report.confThreshold, report.nmsThreshold, (int)report.recording, report.stride,
+                                baseline.source.c_str(), baseline.modelConfiguration.c_str(), baseline.modelWeights.c_str(),
+                                baseline.inpWidth, baseline.inpHeight, baseline.confThreshold, baseline.nmsThreshold, (int)baseline.recording, baseline.stride);
+        return false;
+    }
+
+    double minFps = baseline.fps * (1.0 - tolerance);
+    if (report.fps < minFps) {
+        std::cout << cv::format("FAIL fps %.2f is below baseline %.2f (min %.2f)\n", report.fps, baseline.fps, minFps);
+        passed = false;
+    }
+
+    // Stage times are informational, the end-to-end fps decides
+    const double stages[][2] = {
+        { report.captureTime, baseline.captureTime },
+        { report.inferenceTime, baseline.inferenceTime },
+        { report.postprocessTime, baseline.postprocessTime },
+        { report.composeTime, baseline.composeTime },
+    };
+    const char* stageNames[] = { "capture", "inference", "postprocess", "compose" };
+    for (int i = 0; i < 4; ++i) {
+        if (stages[i][0] > stages[i][1] * (1.0 + tolerance)) {
+            std::cout << cv::format("WARN %s %.2f ms is above baseline %.2f ms\n", stageNames[i], stages[i][0], stages[i][1]);
+        }
+    }
+
+    if (report.frames.size() != baseline.frames.size()) {
+        std::cout << cv::format("FAIL processed [ %d ] frames, baseline [ %d ]\n",
+                                (int)report.frames.size(), (int)baseline.frames.size());
+        return false;
+    }
+
+    for (size_t i = 0; i < report.frames.size(); ++i) {
+        const ReplayFrame& frame = report.frames[i];
+        const ReplayFrame& expected = baseline.frames[i];
+        if (frame.index != expected.index || std::abs(frame.peopleQty - expected.peopleQty) > count_tolerance) {
+            std::cout << cv::format("FAIL frame %d: [ %d ] peoples, baseline frame %d: [ %d ] peoples\n",
+                                    frame.index, frame.peopleQty, expected.index, expected.peopleQty);
+            passed = false;
+        }
+    }
+
+    std::cout << (passed ? "Replay matches baseline\n" : "Replay differs from baseline\n");
+    return passed;
+}
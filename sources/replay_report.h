@@ -0,0 +1,62 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <opencv2/core.hpp>
+
+
+
+struct ReplayFrame
+{
+    int index;                      // frame number in the source video
+    double timestamp;               // simulated time of the frame, s
+    int peopleQty;
+};
+
+// Result of driving a recorded video through the whole pipeline.
+// Stage times are means over the processed frames, ms. Capture includes decoding
+// the frames skipped by the stride, so the stages add up to the end-to-end time.
+// The pipeline runs sequentially on one thread, so thread and lock contention of
+// the live producer/processor threads is not measured.
+struct ReplayReport
+{
+    ReplayReport();
+
+    // Run configuration, the baseline must match it
+    std::string source;
+    std::string modelConfiguration;
+    std::string modelWeights;
+    int inpWidth;
+    int inpHeight;
+    float confThreshold;
+    float nmsThreshold;
+    bool recording;                 // recorder overhead is part of the compose stage
+    int stride;                     // every n-th frame of the source is processed
+
+    int readFrames;
+    double sourceFps;
+    double simulatedSeconds;
+    double wallSeconds;
+    double fps;                     // processed frames per wall-clock second
+
+    double captureTime;
+    double inferenceTime;
+    double postprocessTime;
+    double composeTime;
+
+    std::vector<ReplayFrame> frames;
+};
+
+bool writeReplayReport(const std::string& path, const ReplayReport& report);
+bool readReplayReport(const std::string& path, ReplayReport& report);
+void printReplayReport(const ReplayReport& report);
+
+// tolerance is relative to the baseline and applies to fps and stage times.
+// Returns false if the run configuration differs, fps dropped by more than tolerance or
+// a frame count differs by more than count_tolerance, slower stages are only reported
+bool compareReplayReports(const ReplayReport& report, const ReplayReport& baseline,
+                          double tolerance, int count_tolerance);
+
@@ -0,0 +1,153 @@
+#include "video_recorder.h"
+
+VideoRecorder::VideoRecorder(std::string path_prefix, double fps,
+                             int segment_frames, int decimation, size_t queue_size,
+                             std::string fourcc) :
+_pathPrefix(path_prefix),
+_fourcc(fourcc),
+_fps(fps),
+_segmentFrames(std::max(segment_frames, 0)),
+_decimation(std::max(decimation, 1)),
+_queueSize(std::max(queue_size, (size_t)1)),
+_recorderEnabled(false),
+_recorderFailed(false),
+_pushedQty(0),
+_segment(0),
+_segmentFramesWritten(0),
+_encodedQty(0),
+_droppedQty(0)
+{
+    CV_Assert(_fps > 0.0);
+    if (_fourcc.size() != 4) {
+        _fourcc = "MJPG";
+    }
+}
+
+VideoRecorder::~VideoRecorder() {
+    stop();
+}
+
+void VideoRecorder::start() {
+    std::lock_guard<std::mutex> lck(_mutexQueue);
+    if (_recorderEnabled) {
+        return;
+    }
+    _recorderEnabled = true;
+    _encoderThread = std::thread(&VideoRecorder::encoder, this);
+}
+
+void VideoRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lck(_mutexQueue);
+        _recorderEnabled = false;
+    }
+    _queueCondition.notify_all();
+
+    if (_encoderThread.joinable()) {
+        _encoderThread.join();
+    }
+}
+
+bool VideoRecorder::push(const cv::Mat& frame) {
+    if (frame.empty()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(_mutexQueue);
+        if (!_recorderEnabled || _recorderFailed) {
+            return false;
+        }
+
+        // Frame decimation
+        if (_pushedQty++ % _decimation != 0) {
+            return false;
+        }
+
+        // Drop on backpressure, the caller must never wait for the encoder
+        if (_queue.size() >= _queueSize) {
+            _droppedQty++;
+            return false;
+        }
+        _queue.push_back(frame.clone());
+    }
+    _queueCondition.notify_one();
+    return true;
+}
+
+size_t VideoRecorder::getEncodedQty() {
+    return _encodedQty;
+}
+
+size_t VideoRecorder::getDroppedQty() {
+    return _droppedQty;
+}
+
+bool VideoRecorder::isFailed() {
+    return _recorderFailed;
+}
+
+void VideoRecorder::encoder() {
+    std::cout << "\nStarting Recorder Thread\n";
+    cv::Mat frame;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lck(_mutexQueue);
+            _queueCondition.wait(lck, [this] { return !_recorderEnabled || !_queue.empty(); });
+
+            // Drain the queue before leaving so the last frames are archived too
+            if (_queue.empty()) {
+                break;
+            }
+            frame = _queue.front();
+            _queue.pop_front();
+        }
+
+        // Start a new file when the segment is full or the frame size changed
+        if (!_writer.isOpened() ||
+            frame.size() != _segmentFrameSize ||
+            (_segmentFrames > 0 && _segmentFramesWritten >= _segmentFrames)) {
+            if (!openSegment(frame.size())) {
+                // Don't retry on every frame, the path or codec won't get better
+                std::lock_guard<std::mutex> lck(_mutexQueue);
+                _recorderFailed = true;
+                _droppedQty += _queue.size() + 1;
+                _queue.clear();
+                break;
+            }
+        }
+
+        _writer.write(frame);
+        _segmentFramesWritten++;
+        _encodedQty++;
+    }
+
+    if (_writer.isOpened()) {
+        _writer.release();
+    }
+    std::cout << "\nStopping Recorder Thread\n";
+}
+
+bool VideoRecorder::openSegment(const cv::Size& size) {
+    if (_writer.isOpened()) {
+        _writer.release();
+        _segment++;
+    }
+
+    std::string fileName = segmentFileName(_segment);
+    int fourcc = cv::VideoWriter::fourcc(_fourcc[0], _fourcc[1], _fourcc[2], _fourcc[3]);
+    _writer.open(fileName, fourcc, _fps, size, true);
+    _segmentFrameSize = size;
+    _segmentFramesWritten = 0;
+
+    if (!_writer.isOpened()) {
+        std::cerr << "Recorder can't open " << fileName << "\n";
+        return false;
+    }
+    return true;
+}
+
+std::string VideoRecorder::segmentFileName(int segment) {
+    return cv::format("%s_%03d.avi", _pathPrefix.c_str(), segment);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <opencv2/videoio.hpp>
+
+
+
+// Archives annotated frames to disk on its own encoder thread.
+// Frames are handed over through a bounded queue; when the queue is full the
+// new frame is dropped so that capture and inference never wait on encoding.
+class VideoRecorder
+{
+public:
+    VideoRecorder(std::string path_prefix, double fps,
+                  int segment_frames, int decimation, size_t queue_size,
+                  std::string fourcc = "MJPG");
+    ~VideoRecorder();
+
+    void start();
+    void stop();
+    // Non-blocking, returns false if the frame was skipped or dropped
+    bool push(const cv::Mat& frame);
+
+    size_t getEncodedQty();
+    size_t getDroppedQty();
+    // The output file couldn't be opened, recording has stopped
+    bool isFailed();
+
+private:
+    void encoder();
+    bool openSegment(const cv::Size& size);
+    std::string segmentFileName(int segment);
+
+    cv::VideoWriter _writer;
+    std::string _pathPrefix;        // output file prefix, segment index and extension are appended
+    std::string _fourcc;            // codec of the output files
+    double _fps;                    // frame rate written into the output files
+    int _segmentFrames;             // frames per output file, 0 - single file
+    int _decimation;                // keep every n-th pushed frame
+    size_t _queueSize;              // max frames waiting for the encoder
+
+    std::deque<cv::Mat> _queue;
+    std::thread _encoderThread;
+    std::mutex _mutexQueue;
+    std::condition_variable _queueCondition;
+    bool _recorderEnabled;
+    std::atomic<bool> _recorderFailed;
+
+    size_t _pushedQty;
+    int _segment;
+    int _segmentFramesWritten;
+    cv::Size _segmentFrameSize;
+    std::atomic<size_t> _encodedQty;
+    std::atomic<size_t> _droppedQty;
+};
+